@@ -0,0 +1,655 @@
+/*
+batch_worker.c - Distribute slicer/fur_gen jobs across machines through a shared queue directory.
+
+Any number of worker processes, on one machine or on several machines sharing a
+filesystem (e.g. an NFS mount), pull jobs from the same queue directory. There is
+no scheduler service: every state change is a single atomic rename().
+
+Queue layout:
+  tmp/      job files being written by "add" (renamed into pending/ when complete)
+  pending/  <job>             unclaimed jobs
+  running/  <job>@<worker>    leases; the lease file's mtime is the owner's heartbeat
+  done/     <job>             finished jobs
+  failed/   <job>             jobs whose tool exited with a non-zero status
+  logs/     <job>.log         tool stdout/stderr of the latest attempt
+  workers/  <worker>          per-worker heartbeat, also used to read the server clock
+
+A job file holds the tool name (slicer, fur_gen or furnace_gen) on its first line
+followed by one tool argument per line. "add" stores the input and output paths
+as absolute paths, since workers on other nodes run from other directories.
+
+Leases whose heartbeat is older than lease_seconds are renamed back to pending/
+by any other worker, so jobs of crashed or disconnected workers are retried.
+Expiry is measured against the mtime of the worker's own freshly touched heartbeat
+file, so clock skew between nodes does not matter. Leases are re-opened before
+their mtime is read, because NFS clients revalidate cached attributes on open()
+but may serve stat() from a cache that is up to acregmax (60 s) old.
+lease_seconds must be at least LEASE_RATIO times heartbeat_seconds, so a live
+lease is always renewed several times within one lease period. Tool output is written to a
+private "<output>.<worker>.part" path and renamed into place only on success, so
+a retried job never leaves a half-written result behind.
+
+Usage:
+  ./batch_worker add <queue_dir> <job_name> <tool> [tool_args...]
+  ./batch_worker work <queue_dir> [lease_seconds] [heartbeat_seconds]
+
+A worker exits once no jobs are pending or running. Tools are looked up next to
+the batch_worker executable, or on PATH if it was started without a directory.
+
+POSIX only (uses fork/exec).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#define MAX_PATH          1024
+#define MAX_JOB_SIZE      8192  /* Job files are a handful of short lines */
+#define MAX_JOB_ARGS      16
+#define MAX_WORKER_ID     127   /* <host>-<pid>, see main() */
+#define MAX_JOB_NAME      (NAME_MAX - 1 - MAX_WORKER_ID)  /* "<job>@<worker>" must fit in NAME_MAX */
+#define DEFAULT_LEASE     60    /* Seconds without heartbeat before a lease may be reclaimed */
+#define DEFAULT_HEARTBEAT 10    /* Seconds between lease heartbeats */
+#define LEASE_RATIO       3     /* Minimum lease_seconds / heartbeat_seconds */
+#define POLL_INTERVAL     2     /* Seconds between queue scans when no job is claimable */
+
+/* ---------- Tools ---------- */
+
+typedef struct {
+    const char *name;
+    int min_args;       /* required argument count */
+    int input_arg;      /* index of the input path among the tool arguments */
+    int output_arg;     /* index of the output path among the tool arguments */
+    int output_is_dir;  /* output is a folder of files rather than a single file */
+} ToolInfo;
+
+static const ToolInfo TOOLS[] = {
+    { "slicer",      7, 0, 5, 1 },  /* <file> <bpm> <rpb> <rows> <mode> <output_folder> <prefix> */
+    { "fur_gen",     5, 0, 4, 0 },  /* <input_dir> <bpm> <rpb> <rows> <output_file> */
+    { "furnace_gen", 5, 0, 4, 0 },  /* <input_dir> <bpm> <rpb> <rows> <output_file> [name] */
+};
+
+static const ToolInfo *find_tool(const char *name) {
+    for (size_t i = 0; i < sizeof(TOOLS) / sizeof(TOOLS[0]); i++)
+        if (!strcmp(TOOLS[i].name, name)) return &TOOLS[i];
+    return NULL;
+}
+
+/* ---------- Job files ---------- */
+
+typedef struct {
+    char text[MAX_JOB_SIZE];
+    const ToolInfo *tool;
+    char *args[MAX_JOB_ARGS];
+    int n_args;
+} Job;
+
+/* Parse a job file. Returns 0 on success. */
+static int read_job(const char *path, Job *job) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open job '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t len = fread(job->text, 1, sizeof(job->text) - 1, fp);
+    fclose(fp);
+    job->text[len] = '\0';
+
+    char *lines[MAX_JOB_ARGS + 1];
+    int n_lines = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(job->text, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        if (n_lines == MAX_JOB_ARGS + 1) {
+            fprintf(stderr, "Error: Job '%s' has more than %d arguments.\n", path, MAX_JOB_ARGS);
+            return -1;
+        }
+        lines[n_lines++] = line;
+    }
+
+    job->tool = n_lines > 0 ? find_tool(lines[0]) : NULL;
+    if (!job->tool || n_lines - 1 < job->tool->min_args) {
+        fprintf(stderr, "Error: Job '%s' is not a valid slicer/fur_gen/furnace_gen job.\n", path);
+        return -1;
+    }
+    job->n_args = n_lines - 1;
+    for (int i = 0; i < job->n_args; i++) job->args[i] = lines[i + 1];
+    return 0;
+}
+
+/* ---------- Worker ---------- */
+
+typedef struct {
+    const char *queue;
+    char id[MAX_WORKER_ID + 1];
+    char self_dir[MAX_PATH];  /* directory of the batch_worker executable, "" to use PATH */
+    int lease_seconds;
+    int heartbeat_seconds;
+} Worker;
+
+enum { JOB_DONE, JOB_FAILED, JOB_LOST };
+
+/* Process group of the running tool. slicer runs ffmpeg through system(),
+   so stopping a job must reach the whole group, not just the direct child. */
+static volatile pid_t current_job = 0;
+
+/* Terminate a tool's process group and wait until every member is gone */
+static void stop_job(pid_t pid) {
+    int status;
+    kill(-pid, SIGTERM);
+    waitpid(pid, &status, 0);
+    for (int i = 0; i < 5 && kill(-pid, 0) == 0; i++) sleep(1);  /* grandchildren exit on their own */
+    if (kill(-pid, 0) == 0) {
+        kill(-pid, SIGKILL);
+        while (kill(-pid, 0) == 0) sleep(1);
+    }
+    current_job = 0;
+}
+
+/* SIGINT/SIGTERM/SIGHUP: take the running tool down with the worker */
+static void on_exit_signal(int sig) {
+    if (current_job > 0) kill(-current_job, SIGTERM);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static const char *QUEUE_DIRS[] = { "tmp", "pending", "running", "done", "failed", "logs", "workers" };
+
+static int make_queue_dirs(const char *queue) {
+    char path[MAX_PATH];
+    if (mkdir(queue, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Could not create queue directory '%s': %s\n", queue, strerror(errno));
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(QUEUE_DIRS) / sizeof(QUEUE_DIRS[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", queue, QUEUE_DIRS[i]);
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+            fprintf(stderr, "Error: Could not create '%s': %s\n", path, strerror(errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Current time according to the shared filesystem: touch our heartbeat file and read its mtime */
+static int server_now(const Worker *w, time_t *now) {
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "%s/workers/%s", w->queue, w->id);
+
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) return -1;
+    close(fd);
+
+    struct stat st;
+    if (utime(path, NULL) != 0 || stat(path, &st) != 0) return -1;
+    *now = st.st_mtime;
+    return 0;
+}
+
+/* Path the tool writes to before its result is published */
+static void part_path(char *buf, size_t size, const char *output, const char *worker_id) {
+    size_t len = strlen(output);
+    while (len > 1 && output[len - 1] == '/') len--;  /* "out/" -> "out.<worker>.part" */
+    snprintf(buf, size, "%.*s.%s.part", (int)len, output, worker_id);
+}
+
+/* Remove a partial result: a single file, or a flat folder of slice files */
+static void remove_part(const char *path, int is_dir) {
+    if (!is_dir) {
+        unlink(path);
+        return;
+    }
+    DIR *dir = opendir(path);
+    if (!dir) return;
+    struct dirent *ent;
+    char entry[MAX_PATH];
+    while ((ent = readdir(dir)) != NULL) {
+        if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, "..")) continue;
+        snprintf(entry, sizeof(entry), "%s/%s", path, ent->d_name);
+        unlink(entry);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+/* Move a successful result into place. Each file lands with one rename(), so a
+   concurrent retry of the same job can only replace a file with an identical one. */
+static int publish_part(const char *part, const char *output, int is_dir) {
+    if (!is_dir) {
+        if (rename(part, output) != 0) {
+            fprintf(stderr, "Error: Could not publish '%s': %s\n", output, strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    if (mkdir(output, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Could not create output directory '%s': %s\n", output, strerror(errno));
+        return -1;
+    }
+    DIR *dir = opendir(part);
+    if (!dir) {
+        fprintf(stderr, "Error: Cannot open '%s': %s\n", part, strerror(errno));
+        return -1;
+    }
+    int ret = 0;
+    struct dirent *ent;
+    char src[MAX_PATH], dst[MAX_PATH];
+    while ((ent = readdir(dir)) != NULL) {
+        if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, "..")) continue;
+        snprintf(src, sizeof(src), "%s/%s", part, ent->d_name);
+        snprintf(dst, sizeof(dst), "%s/%s", output, ent->d_name);
+        if (rename(src, dst) != 0) {
+            fprintf(stderr, "Error: Could not publish '%s': %s\n", dst, strerror(errno));
+            ret = -1;
+        }
+    }
+    closedir(dir);
+    rmdir(part);
+    return ret;
+}
+
+/* Run one claimed job with heartbeats. Returns JOB_DONE, JOB_FAILED or JOB_LOST. */
+static int run_job(const Worker *w, const char *name, const char *lease) {
+    Job job;
+    if (read_job(lease, &job) != 0) return JOB_FAILED;
+
+    const ToolInfo *tool = job.tool;
+    const char *output = job.args[tool->output_arg];
+    char part[MAX_PATH];
+    part_path(part, sizeof(part), output, w->id);
+    remove_part(part, tool->output_is_dir);  /* leftovers of an earlier attempt by this worker id */
+
+    char tool_path[MAX_PATH];
+    if (w->self_dir[0])
+        snprintf(tool_path, sizeof(tool_path), "%s/%s", w->self_dir, tool->name);
+    else
+        snprintf(tool_path, sizeof(tool_path), "%s", tool->name);
+
+    char *argv[MAX_JOB_ARGS + 2];
+    argv[0] = tool_path;
+    for (int i = 0; i < job.n_args; i++)
+        argv[i + 1] = (i == tool->output_arg) ? part : job.args[i];
+    argv[job.n_args + 1] = NULL;
+
+    char log_path[MAX_PATH];
+    snprintf(log_path, sizeof(log_path), "%s/logs/%s.log", w->queue, name);
+    int log_fd = open(log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log_fd < 0) {
+        fprintf(stderr, "Error: Cannot create log '%s': %s\n", log_path, strerror(errno));
+        return JOB_FAILED;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "Error: fork failed: %s\n", strerror(errno));
+        close(log_fd);
+        return JOB_FAILED;
+    }
+    if (pid == 0) {
+        setpgid(0, 0);
+#ifdef __linux__
+        prctl(PR_SET_PDEATHSIG, SIGTERM);  /* don't outlive a killed worker and race the retry */
+#endif
+        dup2(log_fd, STDOUT_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+        close(log_fd);
+        if (w->self_dir[0]) execv(tool_path, argv);
+        else execvp(tool_path, argv);
+        fprintf(stderr, "Error: Cannot run '%s': %s\n", tool_path, strerror(errno));
+        _exit(127);
+    }
+    setpgid(pid, pid);  /* also in the parent, so kill(-pid) cannot race the child's setpgid */
+    current_job = pid;
+    close(log_fd);
+
+    /* Wait for the tool, renewing the lease every heartbeat interval */
+    int status = 0;
+    int since_heartbeat = 0;
+    for (;;) {
+        pid_t done = waitpid(pid, &status, WNOHANG);
+        if (done == pid) break;
+        if (done < 0 && errno != EINTR) {
+            fprintf(stderr, "Error: waitpid failed: %s\n", strerror(errno));
+            stop_job(pid);
+            remove_part(part, tool->output_is_dir);
+            return JOB_FAILED;
+        }
+        sleep(1);
+        if (++since_heartbeat < w->heartbeat_seconds) continue;
+        since_heartbeat = 0;
+
+        time_t now;
+        server_now(w, &now);
+        if (utime(lease, NULL) != 0) {
+            /* Lease was reclaimed by another worker: stop and let the new owner finish */
+            fprintf(stderr, "Warning: Lost lease on job '%s', stopping it.\n", name);
+            stop_job(pid);
+            remove_part(part, tool->output_is_dir);
+            return JOB_LOST;
+        }
+    }
+    current_job = 0;
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        remove_part(part, tool->output_is_dir);
+        return JOB_FAILED;
+    }
+    if (publish_part(part, output, tool->output_is_dir) != 0) {
+        remove_part(part, tool->output_is_dir);
+        return JOB_FAILED;
+    }
+    return JOB_DONE;
+}
+
+/* Claim one pending job by renaming it into running/. Returns 1 if claimed.
+   Jobs that cannot be claimed are moved to failed/ and counted in *n_failed. */
+static int claim_job(const Worker *w, char *name, size_t name_size, char *lease, size_t lease_size,
+                     int *n_failed) {
+    char pending[MAX_PATH];
+    snprintf(pending, sizeof(pending), "%s/pending", w->queue);
+    DIR *dir = opendir(pending);
+    if (!dir) return 0;
+
+    int claimed = 0;
+    struct dirent *ent;
+    char src[MAX_PATH];
+    while (!claimed && (ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        snprintf(src, sizeof(src), "%s/%s", pending, ent->d_name);
+        snprintf(lease, lease_size, "%s/running/%s@%s", w->queue, ent->d_name, w->id);
+
+        /* Refresh mtime first: rename keeps it, and a stale mtime would look like an expired lease */
+        if (utime(src, NULL) == 0 && rename(src, lease) == 0) {
+            snprintf(name, name_size, "%s", ent->d_name);
+            claimed = 1;
+            continue;
+        }
+        if (errno == ENOENT) continue;  /* another worker claimed it first */
+
+        /* Anything else would fail the same way on every poll: park the job in failed/ */
+        fprintf(stderr, "Error: Cannot claim job '%s': %s\n", ent->d_name, strerror(errno));
+        char failed[MAX_PATH];
+        snprintf(failed, sizeof(failed), "%s/failed/%s", w->queue, ent->d_name);
+        if (rename(src, failed) == 0)
+            (*n_failed)++;
+        else if (errno != ENOENT)
+            fprintf(stderr, "Error: Could not move job '%s' to failed/: %s\n", ent->d_name, strerror(errno));
+    }
+    closedir(dir);
+    return claimed;
+}
+
+/* Move expired leases back to pending/ so another worker retries them */
+static void reclaim_expired(const Worker *w) {
+    time_t now;
+    if (server_now(w, &now) != 0) return;
+
+    char running[MAX_PATH];
+    snprintf(running, sizeof(running), "%s/running", w->queue);
+    DIR *dir = opendir(running);
+    if (!dir) return;
+
+    struct dirent *ent;
+    char lease[MAX_PATH], pending[MAX_PATH];
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        snprintf(lease, sizeof(lease), "%s/%s", running, ent->d_name);
+
+        /* open() forces NFS to refetch attributes; a cached stat() could show an old heartbeat */
+        struct stat st;
+        int fd = open(lease, O_RDONLY);
+        if (fd < 0) continue;
+        int ok = fstat(fd, &st) == 0;
+        close(fd);
+        if (!ok || now - st.st_mtime <= w->lease_seconds) continue;
+
+        char *at = strchr(ent->d_name, '@');
+        if (!at) continue;
+        snprintf(pending, sizeof(pending), "%s/pending/%.*s", w->queue, (int)(at - ent->d_name), ent->d_name);
+        if (rename(lease, pending) != 0) continue;  /* finished or reclaimed meanwhile */
+        printf("Reclaimed job '%.*s' from expired worker '%s'.\n",
+               (int)(at - ent->d_name), ent->d_name, at + 1);
+
+        /* Drop the dead worker's partial output */
+        Job job;
+        if (read_job(pending, &job) == 0) {
+            char part[MAX_PATH];
+            part_path(part, sizeof(part), job.args[job.tool->output_arg], at + 1);
+            remove_part(part, job.tool->output_is_dir);
+        }
+    }
+    closedir(dir);
+}
+
+static int dir_has_entries(const char *path) {
+    DIR *dir = opendir(path);
+    if (!dir) return 0;
+    struct dirent *ent;
+    int found = 0;
+    while (!found && (ent = readdir(dir)) != NULL)
+        if (ent->d_name[0] != '.') found = 1;
+    closedir(dir);
+    return found;
+}
+
+static int work(Worker *w) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_exit_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+
+    printf("Worker %s serving queue '%s' (lease %ds, heartbeat %ds)\n",
+           w->id, w->queue, w->lease_seconds, w->heartbeat_seconds);
+    fflush(stdout);
+
+    char pending[MAX_PATH], running[MAX_PATH];
+    snprintf(pending, sizeof(pending), "%s/pending", w->queue);
+    snprintf(running, sizeof(running), "%s/running", w->queue);
+
+    int n_done = 0, n_failed = 0;
+    for (;;) {
+        reclaim_expired(w);
+
+        char name[NAME_MAX + 1], lease[MAX_PATH];
+        if (!claim_job(w, name, sizeof(name), lease, sizeof(lease), &n_failed)) {
+            /* Keep polling while other workers' leases might still expire */
+            if (!dir_has_entries(pending) && !dir_has_entries(running)) break;
+            sleep(POLL_INTERVAL);
+            continue;
+        }
+
+        printf("Running job '%s'...\n", name);
+        fflush(stdout);
+        int result = run_job(w, name, lease);
+        if (result == JOB_LOST) continue;
+
+        char dest[MAX_PATH];
+        snprintf(dest, sizeof(dest), "%s/%s/%s", w->queue, result == JOB_DONE ? "done" : "failed", name);
+        if (rename(lease, dest) != 0) {
+            /* Reclaimed after the tool finished; the retry produces the same result */
+            fprintf(stderr, "Warning: Lease on job '%s' expired before completion was recorded.\n", name);
+            continue;
+        }
+        if (result == JOB_DONE) {
+            printf("Job '%s' done.\n", name);
+            n_done++;
+        } else {
+            fprintf(stderr, "Job '%s' failed, see %s/logs/%s.log\n", name, w->queue, name);
+            n_failed++;
+        }
+        fflush(stdout);
+    }
+
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "%s/workers/%s", w->queue, w->id);
+    unlink(path);
+
+    printf("Queue empty. Worker %s finished: %d done, %d failed.\n", w->id, n_done, n_failed);
+    return n_failed > 0 ? 1 : 0;
+}
+
+/* Write a job file into tmp/ and rename it into pending/ so workers never see a partial job */
+static int add_job(const char *queue, const char *name, int argc, char *argv[]) {
+    if (!name[0] || name[0] == '.' || strpbrk(name, "/@\n")) {
+        fprintf(stderr, "Error: Job name '%s' must not be empty, start with '.' or contain '/', '@'.\n", name);
+        return 1;
+    }
+    if (strlen(name) > MAX_JOB_NAME) {
+        fprintf(stderr, "Error: Job name is longer than %d characters.\n", MAX_JOB_NAME);
+        return 1;
+    }
+    const ToolInfo *tool = find_tool(argv[0]);
+    if (!tool) {
+        fprintf(stderr, "Error: Unknown tool '%s'. Use slicer, fur_gen or furnace_gen.\n", argv[0]);
+        return 1;
+    }
+    if (argc - 1 < tool->min_args || argc - 1 > MAX_JOB_ARGS) {
+        fprintf(stderr, "Error: %s needs %d to %d arguments, got %d.\n",
+                tool->name, tool->min_args, MAX_JOB_ARGS, argc - 1);
+        return 1;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (!argv[i][0] || strchr(argv[i], '\n')) {
+            fprintf(stderr, "Error: Job arguments must be non-empty and single-line.\n");
+            return 1;
+        }
+    }
+
+    /* Resolve input/output paths here; each worker has its own working directory */
+    char cwd[MAX_PATH];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        fprintf(stderr, "Error: Cannot get working directory: %s\n", strerror(errno));
+        return 1;
+    }
+    char paths[2][MAX_PATH];
+    const int path_args[2] = { tool->input_arg + 1, tool->output_arg + 1 };
+    for (int k = 0; k < 2; k++) {
+        const char *arg = argv[path_args[k]];
+        int len = arg[0] == '/' ? snprintf(paths[k], MAX_PATH, "%s", arg)
+                                : snprintf(paths[k], MAX_PATH, "%s/%s", cwd, arg);
+        if (len >= MAX_PATH) {
+            fprintf(stderr, "Error: Path '%s' is too long.\n", arg);
+            return 1;
+        }
+        argv[path_args[k]] = paths[k];
+    }
+
+    size_t job_size = 0;
+    for (int i = 0; i < argc; i++) job_size += strlen(argv[i]) + 1;
+    if (job_size >= MAX_JOB_SIZE) {
+        fprintf(stderr, "Error: Job is larger than %d bytes.\n", MAX_JOB_SIZE - 1);
+        return 1;
+    }
+    if (make_queue_dirs(queue) != 0) return 1;
+
+    char tmp[MAX_PATH], dest[MAX_PATH];
+    snprintf(tmp, sizeof(tmp), "%s/tmp/%s.%ld", queue, name, (long)getpid());
+    snprintf(dest, sizeof(dest), "%s/pending/%s", queue, name);
+
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot create '%s': %s\n", tmp, strerror(errno));
+        return 1;
+    }
+    for (int i = 0; i < argc; i++) fprintf(fp, "%s\n", argv[i]);
+    if (fclose(fp) != 0 || rename(tmp, dest) != 0) {
+        fprintf(stderr, "Error: Could not queue job '%s': %s\n", name, strerror(errno));
+        unlink(tmp);
+        return 1;
+    }
+    printf("Queued job '%s' (%s)\n", name, tool->name);
+    return 0;
+}
+
+/* ---------- Main ---------- */
+
+static void print_usage(FILE *out) {
+    fprintf(out, "Usage: ./batch_worker add <queue_dir> <job_name> <tool> [tool_args...]\n"
+                 "       ./batch_worker work <queue_dir> [lease_seconds] [heartbeat_seconds]\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 2 && (!strcmp(argv[1], "--help") || !strcmp(argv[1], "-h"))) {
+        print_usage(stdout);
+        printf("\nRuns slicer/fur_gen/furnace_gen jobs from a queue directory shared between\n"
+               "worker processes, possibly on several machines. tool is one of slicer,\n"
+               "fur_gen or furnace_gen and takes its usual arguments.\n");
+        return 0;
+    }
+
+    if (argc >= 5 && !strcmp(argv[1], "add"))
+        return add_job(argv[2], argv[3], argc - 4, argv + 4);
+
+    if (argc < 3 || strcmp(argv[1], "work") != 0) {
+        fprintf(stderr, "Error: Insufficient arguments.\n");
+        print_usage(stderr);
+        return 1;
+    }
+
+    Worker w;
+    w.queue = argv[2];
+    w.lease_seconds = DEFAULT_LEASE;
+    w.heartbeat_seconds = DEFAULT_HEARTBEAT;
+
+    char *endptr;
+    if (argc > 3) {
+        errno = 0;
+        long v = strtol(argv[3], &endptr, 10);
+        if (*endptr || errno || v <= 0) {
+            fprintf(stderr, "Error: lease_seconds must be a positive integer, got '%s'.\n", argv[3]);
+            return 1;
+        }
+        w.lease_seconds = (int)v;
+    }
+    if (argc > 4) {
+        errno = 0;
+        long v = strtol(argv[4], &endptr, 10);
+        if (*endptr || errno || v <= 0) {
+            fprintf(stderr, "Error: heartbeat_seconds must be a positive integer, got '%s'.\n", argv[4]);
+            return 1;
+        }
+        w.heartbeat_seconds = (int)v;
+    } else if (w.heartbeat_seconds * LEASE_RATIO > w.lease_seconds) {
+        w.heartbeat_seconds = w.lease_seconds / LEASE_RATIO > 0 ? w.lease_seconds / LEASE_RATIO : 1;
+    }
+    if (w.heartbeat_seconds * LEASE_RATIO > w.lease_seconds) {
+        fprintf(stderr, "Error: lease_seconds (%d) must be at least %d times heartbeat_seconds (%d).\n",
+                w.lease_seconds, LEASE_RATIO, w.heartbeat_seconds);
+        return 1;
+    }
+
+    /* Worker id: <host>-<pid>, unique across nodes sharing the queue */
+    char host[64];
+    if (gethostname(host, sizeof(host)) != 0) snprintf(host, sizeof(host), "host");
+    host[sizeof(host) - 1] = '\0';
+    for (char *p = host; *p; p++)
+        if (*p == '/' || *p == '@' || *p == '.') *p = '_';
+    snprintf(w.id, sizeof(w.id), "%s-%ld", host, (long)getpid());
+
+    /* Tools live next to batch_worker, like the GUI expects */
+    const char *slash = strrchr(argv[0], '/');
+    if (slash)
+        snprintf(w.self_dir, sizeof(w.self_dir), "%.*s", (int)(slash - argv[0]), argv[0]);
+    else
+        w.self_dir[0] = '\0';
+
+    if (make_queue_dirs(w.queue) != 0) return 1;
+    return work(&w);
+}
@@ -18,16 +18,17 @@ Usage: ./furnace_gen <input_dir> <bpm> <rows_per_beat> <pattern_rows> <output_fi
 
 #define MAX_SAMPLES 256
 #define WAV_HEADER_MIN 44
+#define HEX_BLOCK_SIZE 65536   // PCM bytes read per block when streaming hex dumps (multiple of 16)
 
 static const char *NOTE_NAMES[] = {
     "C-", "C#", "D-", "D#", "E-", "F-", "F#", "G-", "G#", "A-", "A#", "B-"
 };
 
-// WAV PCM data extracted from a file
+// WAV metadata located by a header-only scan; PCM stays on disk until export
 typedef struct {
     char filename[256];    // just the filename (e.g. "00.wav")
     char name[256];        // filename without extension (e.g. "00")
-    unsigned char *pcm;    // raw PCM data bytes
+    long pcm_offset;       // file offset of the first PCM byte in the data chunk
     long pcm_len;          // length of PCM data in bytes
     long n_samples;        // number of audio samples (pcm_len / (bit_depth/8))
     int sample_rate;
@@ -51,15 +52,16 @@ static unsigned long read_u32_le(const unsigned char *buf) {
     return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((unsigned long)buf[3] << 24);
 }
 
-// Read a WAV file, extract raw PCM data. Returns 0 on success.
-static int read_wav(const char *filepath, SampleData *out) {
+// Scan a WAV file's chunk headers and record where its PCM data lives.
+// Only the RIFF header and fmt chunk are read; the data chunk is skipped.
+// Returns 0 on success.
+static int scan_wav(const char *filepath, SampleData *out) {
     FILE *fp = fopen(filepath, "rb");
     if (!fp) {
         fprintf(stderr, "Error: Cannot open '%s': %s\n", filepath, strerror(errno));
         return -1;
     }
 
-    // Read entire file
     fseek(fp, 0, SEEK_END);
     long file_size = ftell(fp);
     fseek(fp, 0, SEEK_SET);
@@ -70,101 +72,123 @@ static int read_wav(const char *filepath, SampleData *out) {
         return -1;
     }
 
-    unsigned char *file_data = malloc(file_size);
-    if (!file_data) {
-        fprintf(stderr, "Error: Memory allocation failed for '%s'.\n", filepath);
-        fclose(fp);
-        return -1;
-    }
-
-    if (fread(file_data, 1, file_size, fp) != (size_t)file_size) {
-        fprintf(stderr, "Error: Failed to read '%s'.\n", filepath);
-        free(file_data);
-        fclose(fp);
-        return -1;
-    }
-    fclose(fp);
-
     // Validate RIFF/WAVE header
-    if (memcmp(file_data, "RIFF", 4) != 0 || memcmp(file_data + 8, "WAVE", 4) != 0) {
+    unsigned char riff[12];
+    if (fread(riff, 1, sizeof(riff), fp) != sizeof(riff) ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
         fprintf(stderr, "Error: '%s' is not a valid WAV file.\n", filepath);
-        free(file_data);
+        fclose(fp);
         return -1;
     }
 
-    // Find fmt and data chunks
+    // Walk chunk headers to find fmt and data chunks
     int fmt_found = 0;
     int channels = 0, sample_rate = 0, bits_per_sample = 0;
-    unsigned char *pcm_data = NULL;
+    long pcm_offset = -1;
     long pcm_len = 0;
 
     long offset = 12; // skip RIFF header
     while (offset + 8 <= file_size) {
-        unsigned long chunk_size = read_u32_le(file_data + offset + 4);
-
-        if (memcmp(file_data + offset, "fmt ", 4) == 0) {
-            if (offset + 8 + chunk_size > (unsigned long)file_size || chunk_size < 16) {
+        unsigned char chunk[8];
+        if (fseek(fp, offset, SEEK_SET) != 0 || fread(chunk, 1, 8, fp) != 8) break;
+        unsigned long chunk_size = read_u32_le(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[16];
+            if (offset + 8 + chunk_size > (unsigned long)file_size || chunk_size < 16 ||
+                fread(fmt, 1, sizeof(fmt), fp) != sizeof(fmt)) {
                 fprintf(stderr, "Error: Invalid fmt chunk in '%s'.\n", filepath);
-                free(file_data);
+                fclose(fp);
                 return -1;
             }
-            unsigned int audio_format = read_u16_le(file_data + offset + 8);
+            unsigned int audio_format = read_u16_le(fmt);
             if (audio_format != 1) { // PCM
                 fprintf(stderr, "Error: '%s' is not PCM format (format=%u).\n", filepath, audio_format);
-                free(file_data);
+                fclose(fp);
                 return -1;
             }
-            channels = read_u16_le(file_data + offset + 10);
-            sample_rate = (int)read_u32_le(file_data + offset + 12);
-            bits_per_sample = read_u16_le(file_data + offset + 22);
+            channels = read_u16_le(fmt + 2);
+            sample_rate = (int)read_u32_le(fmt + 4);
+            bits_per_sample = read_u16_le(fmt + 14);
             fmt_found = 1;
-        } else if (memcmp(file_data + offset, "data", 4) == 0) {
+        } else if (memcmp(chunk, "data", 4) == 0) {
             pcm_len = (long)chunk_size;
             if (offset + 8 + pcm_len > file_size) {
                 pcm_len = file_size - offset - 8;
             }
-            pcm_data = file_data + offset + 8;
+            pcm_offset = offset + 8;
         }
 
         offset += 8 + chunk_size;
         // Chunks are word-aligned
         if (chunk_size % 2 != 0) offset++;
     }
+    fclose(fp);
 
-    if (!fmt_found || !pcm_data || pcm_len <= 0) {
+    if (!fmt_found || pcm_offset < 0 || pcm_len <= 0) {
         fprintf(stderr, "Error: Could not find fmt/data chunks in '%s'.\n", filepath);
-        free(file_data);
         return -1;
     }
-
-    // Copy PCM data to output (file_data will be freed)
-    out->pcm = malloc(pcm_len);
-    if (!out->pcm) {
-        fprintf(stderr, "Error: Memory allocation failed for PCM data.\n");
-        free(file_data);
+    if (channels <= 0 || bits_per_sample < 8) {
+        fprintf(stderr, "Error: Unsupported sample layout in '%s' (%d channels, %d-bit).\n",
+                filepath, channels, bits_per_sample);
         return -1;
     }
-    memcpy(out->pcm, pcm_data, pcm_len);
+
+    out->pcm_offset = pcm_offset;
     out->pcm_len = pcm_len;
     out->n_samples = pcm_len / (bits_per_sample / 8) / channels;
     out->sample_rate = sample_rate;
     out->bit_depth = bits_per_sample;
-
-    free(file_data);
     return 0;
 }
 
-// Write the hex dump of PCM data in Furnace text export format
-static void write_hex_dump(FILE *fp, const unsigned char *data, long len) {
-    for (long offset = 0; offset < len; offset += 16) {
-        fprintf(fp, "%08lX:", offset);
-        long remaining = len - offset;
-        long count = remaining < 16 ? remaining : 16;
-        for (long i = 0; i < count; i++) {
-            fprintf(fp, " %02X", data[offset + i]);
+// Stream PCM data from a WAV file as a hex dump in Furnace text export format.
+// Reads HEX_BLOCK_SIZE bytes at a time so memory use is independent of sample size.
+// Returns 0 on success.
+static int write_hex_dump(FILE *fp, const char *filepath, const SampleData *s) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    static unsigned char block[HEX_BLOCK_SIZE];
+    char line[8 + 1 + 16 * 3 + 2];
+
+    FILE *in = fopen(filepath, "rb");
+    if (!in) {
+        fprintf(stderr, "Error: Cannot open '%s': %s\n", filepath, strerror(errno));
+        return -1;
+    }
+    if (fseek(in, s->pcm_offset, SEEK_SET) != 0) {
+        fprintf(stderr, "Error: Cannot seek to PCM data in '%s'.\n", filepath);
+        fclose(in);
+        return -1;
+    }
+
+    long offset = 0;
+    while (offset < s->pcm_len) {
+        long remaining = s->pcm_len - offset;
+        size_t want = remaining < HEX_BLOCK_SIZE ? (size_t)remaining : HEX_BLOCK_SIZE;
+        if (fread(block, 1, want, in) != want) {
+            fprintf(stderr, "Error: Failed to read PCM data from '%s'.\n", filepath);
+            fclose(in);
+            return -1;
+        }
+
+        // HEX_BLOCK_SIZE is a multiple of 16, so lines never straddle blocks
+        for (size_t pos = 0; pos < want; pos += 16, offset += 16) {
+            size_t count = want - pos < 16 ? want - pos : 16;
+            char *p = line + snprintf(line, sizeof(line), "%08lX:", offset);
+            for (size_t i = 0; i < count; i++) {
+                unsigned char byte = block[pos + i];
+                *p++ = ' ';
+                *p++ = HEX_DIGITS[byte >> 4];
+                *p++ = HEX_DIGITS[byte & 0x0F];
+            }
+            *p++ = '\n';
+            fwrite(line, 1, (size_t)(p - line), fp);
         }
-        fputc('\n', fp);
     }
+
+    fclose(in);
+    return 0;
 }
 
 // Get note name for a sample index (0=C-0, 1=C#0, 2=D-0, ...)
@@ -246,7 +270,6 @@ int main(int argc, char *argv[]) {
         char *dot = strrchr(samples[n_samples].name, '.');
         if (dot) *dot = '\0';
 
-        samples[n_samples].pcm = NULL;
         n_samples++;
     }
     closedir(dir);
@@ -259,15 +282,13 @@ int main(int argc, char *argv[]) {
     // Sort alphabetically
     qsort(samples, n_samples, sizeof(SampleData), cmp_samples);
 
-    // Read WAV data for each sample
+    // Scan WAV headers for each sample (PCM is streamed later during export)
     printf("Reading %d WAV files from '%s'...\n", n_samples, input_dir);
     for (int i = 0; i < n_samples; i++) {
         char filepath[512];
         snprintf(filepath, sizeof(filepath), "%s/%s", input_dir, samples[i].filename);
 
-        if (read_wav(filepath, &samples[i]) != 0) {
-            // Cleanup already-loaded samples
-            for (int j = 0; j < i; j++) free(samples[j].pcm);
+        if (scan_wav(filepath, &samples[i]) != 0) {
             return 1;
         }
         printf("  [%02X] %s (%ld samples, %d Hz, %d-bit)\n",
@@ -286,7 +307,6 @@ int main(int argc, char *argv[]) {
     FILE *fp = fopen(output_file, "w");
     if (!fp) {
         fprintf(stderr, "Error: Cannot create '%s': %s\n", output_file, strerror(errno));
-        for (int i = 0; i < n_samples; i++) free(samples[i].pcm);
         return 1;
     }
 
@@ -337,8 +357,14 @@ int main(int argc, char *argv[]) {
         fprintf(fp, "- no BRR filters: no\n");
         fprintf(fp, "- dither: no\n\n");
 
+        char filepath[512];
+        snprintf(filepath, sizeof(filepath), "%s/%s", input_dir, samples[i].filename);
+
         fprintf(fp, "```\n");
-        write_hex_dump(fp, samples[i].pcm, samples[i].pcm_len);
+        if (write_hex_dump(fp, filepath, &samples[i]) != 0) {
+            fclose(fp);
+            return 1;
+        }
         fprintf(fp, "```\n\n\n");
 
         printf("  Sample %d/%d written.\n", i + 1, n_samples);
@@ -374,10 +400,10 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    fclose(fp);
-
-    // Cleanup
-    for (int i = 0; i < n_samples; i++) free(samples[i].pcm);
+    if (fclose(fp) != 0) {
+        fprintf(stderr, "Error: Failed to write '%s': %s\n", output_file, strerror(errno));
+        return 1;
+    }
 
     printf("Furnace text export written to: %s\n", output_file);
     printf("  %d samples, %d orders, BPM=%d, virtual tempo=%d/%d\n",
@@ -2,6 +2,10 @@
 slicer.c is a software that computes slices from an input audio file utilizing ffprobe and ffmpeg for duration and slicing respectively.
 You can utilize the sliced files in Furnace Tracker as samples for audio reference during chiptune creation.
 
+When built with -DUSE_LIBAV (link with -lavformat -lavcodec -lswresample -lavutil, FFmpeg 5.1+),
+the input is opened once and decoded, resampled and cut in-process instead of running ffprobe and
+one ffmpeg child process per slice.
+
 Usage: ./slicer <FILENAME> <BPM> <rows_per_beat> <pattern rows> <naming_mode>
 
 naming_mode: DEC for decimal naming, HEX for hexadecimal naming OBVIOUSLY
@@ -16,6 +20,39 @@ naming_mode: DEC for decimal naming, HEX for hexadecimal naming OBVIOUSLY
 #ifdef _WIN32
 #include <direct.h>
 #endif
+#ifdef USE_LIBAV
+#include <stdint.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/channel_layout.h>
+
+#define OUT_SAMPLE_RATE 44100 // Matches the "-ar 44100 -ac 1 pcm_s16le" output of the ffmpeg CLI path
+#define MAX_GAP_SECONDS 10    // Longer timestamp jumps are discontinuities, not silence to fill
+#define CUTTER_HISTORY 8      // Samples kept for slices that start before the previous one ended
+#endif
+
+// Build the output path of slice i according to the naming mode
+static void build_slice_path(char *filepath, size_t size, const char *output_dir,
+                             const char *slice_prefix, const char *naming_mode, int i) {
+    const char *separator = (strlen(slice_prefix) > 0) ? "_" : "";
+
+    if (strcmp(naming_mode, "DEC") == 0) {
+#ifdef _WIN32
+        snprintf(filepath, size, "%s\\%s%s%02d.wav", output_dir, slice_prefix, separator, i);
+#else
+        snprintf(filepath, size, "%s/%s%s%02d.wav", output_dir, slice_prefix, separator, i);
+#endif
+    } else {
+#ifdef _WIN32
+        snprintf(filepath, size, "%s\\%s%s%02X.wav", output_dir, slice_prefix, separator, i);
+#else
+        snprintf(filepath, size, "%s/%s%s%02X.wav", output_dir, slice_prefix, separator, i);
+#endif
+    }
+}
+
+#ifndef USE_LIBAV
 
 // Escape a string for safe use in a shell command.
 // Returns a newly allocated string that must be freed by the caller.
@@ -101,6 +138,443 @@ double get_audio_duration(const char *FILENAME) {
     return (duration > 0) ? duration : -1; // Return the duration if valid, otherwise -1
 }
 
+#endif /* !USE_LIBAV */
+
+#ifdef USE_LIBAV
+// Writes a continuous stream of 16-bit mono samples into consecutive slice files.
+// Slice i starts at output sample round(i * len) and is slice_len samples long,
+// like "-ss i*len -t len" in the ffmpeg CLI path: starts never drift, and two
+// neighbouring slices may share or skip a sample or two.
+typedef struct {
+    const char *output_dir;
+    const char *slice_prefix;
+    const char *naming_mode;
+    double slice_samples;  // exact slice length in output samples
+    int64_t slice_len;     // samples written per slice, set by cli_slice_length()
+    int total_slices;
+    int index;             // slice currently being written
+    int64_t pos;           // absolute output sample position of the next sample
+    int64_t end;           // absolute output sample position where the current slice ends
+    FILE *fp;              // current slice file, NULL between slices
+    uint32_t written;      // samples written to the current slice
+    int16_t history[CUTTER_HISTORY]; // last samples pushed, oldest first
+} SliceCutter;
+
+static int64_t slice_start(const SliceCutter *c, int i) {
+    return llround((double)i * c->slice_samples);
+}
+
+// Write a 16-bit mono WAV header for the given number of samples
+static int write_wav_header(FILE *fp, uint32_t n_samples) {
+    uint32_t data_len = n_samples * 2;
+    unsigned char h[44];
+    memcpy(h, "RIFF", 4);
+    h[4] = (36 + data_len) & 0xFF; h[5] = ((36 + data_len) >> 8) & 0xFF;
+    h[6] = ((36 + data_len) >> 16) & 0xFF; h[7] = ((36 + data_len) >> 24) & 0xFF;
+    memcpy(h + 8, "WAVEfmt ", 8);
+    h[16] = 16; h[17] = 0; h[18] = 0; h[19] = 0;                // fmt chunk size
+    h[20] = 1; h[21] = 0;                                        // PCM
+    h[22] = 1; h[23] = 0;                                        // mono
+    h[24] = OUT_SAMPLE_RATE & 0xFF; h[25] = (OUT_SAMPLE_RATE >> 8) & 0xFF;
+    h[26] = (OUT_SAMPLE_RATE >> 16) & 0xFF; h[27] = 0;
+    h[28] = (OUT_SAMPLE_RATE * 2) & 0xFF; h[29] = ((OUT_SAMPLE_RATE * 2) >> 8) & 0xFF;
+    h[30] = ((OUT_SAMPLE_RATE * 2) >> 16) & 0xFF; h[31] = 0;    // byte rate
+    h[32] = 2; h[33] = 0;                                        // block align
+    h[34] = 16; h[35] = 0;                                       // bits per sample
+    memcpy(h + 36, "data", 4);
+    h[40] = data_len & 0xFF; h[41] = (data_len >> 8) & 0xFF;
+    h[42] = (data_len >> 16) & 0xFF; h[43] = (data_len >> 24) & 0xFF;
+    return fwrite(h, 1, sizeof(h), fp) == sizeof(h) ? 0 : -1;
+}
+
+// The cutter functions below report their own errors and return -1
+static int cutter_open_slice(SliceCutter *c) {
+    char filepath[1024];
+    build_slice_path(filepath, sizeof(filepath), c->output_dir, c->slice_prefix, c->naming_mode, c->index);
+    printf("Processing slice %d/%d: %s\n", c->index + 1, c->total_slices, filepath);
+
+    c->fp = fopen(filepath, "wb");
+    if (!c->fp) {
+        fprintf(stderr, "Error: Cannot create '%s': %s\n", filepath, strerror(errno));
+        return -1;
+    }
+    int64_t start = slice_start(c, c->index);
+    c->end = start + c->slice_len;
+    // Placeholder header; sizes are patched when the slice is closed.
+    // A slice starting before the previous one ended repeats the shared samples.
+    int64_t shared = c->pos - start;
+    if (shared < 0) shared = 0;
+    if (shared > CUTTER_HISTORY) shared = CUTTER_HISTORY;
+    if (write_wav_header(c->fp, 0) != 0 ||
+        fwrite(c->history + CUTTER_HISTORY - shared, 2, (size_t)shared, c->fp) != (size_t)shared) {
+        fprintf(stderr, "Error: Cannot write '%s': %s\n", filepath, strerror(errno));
+        return -1;
+    }
+    c->written = (uint32_t)shared;
+    return 0;
+}
+
+static int cutter_close_slice(SliceCutter *c) {
+    int ret = 0;
+    if (fseek(c->fp, 0, SEEK_SET) != 0 || write_wav_header(c->fp, c->written) != 0) ret = -1;
+    if (fclose(c->fp) != 0) ret = -1;
+    c->fp = NULL;
+    if (ret != 0) fprintf(stderr, "Error: Cannot finish slice %d: %s\n", c->index + 1, strerror(errno));
+    c->index++;
+    return ret;
+}
+
+// Keep the last samples pushed (pcm == NULL for silence) for cutter_open_slice
+static void cutter_remember(SliceCutter *c, const int16_t *pcm, int64_t n) {
+    int keep = n < CUTTER_HISTORY ? (int)n : CUTTER_HISTORY;
+    memmove(c->history, c->history + keep, (CUTTER_HISTORY - keep) * sizeof(int16_t));
+    if (pcm)
+        memcpy(c->history + CUTTER_HISTORY - keep, pcm + n - keep, keep * sizeof(int16_t));
+    else
+        memset(c->history + CUTTER_HISTORY - keep, 0, keep * sizeof(int16_t));
+}
+
+// Append n samples to the slice stream. pcm == NULL appends silence.
+// Samples past the last slice are discarded.
+static int cutter_push(SliceCutter *c, const int16_t *pcm, int64_t n) {
+    static const int16_t zeros[1024];
+
+    while (n > 0 && c->index < c->total_slices) {
+        if (!c->fp) {
+            // A sample between two slices belongs to neither
+            int64_t skip = slice_start(c, c->index) - c->pos;
+            if (skip > 0) {
+                if (skip > n) skip = n;
+                cutter_remember(c, pcm, skip);
+                if (pcm) pcm += skip;
+                c->pos += skip;
+                n -= skip;
+                continue;
+            }
+            if (cutter_open_slice(c) != 0) return -1;
+        }
+
+        int64_t take = c->end - c->pos;
+        if (take > n) take = n;
+
+        // Assumes host is little-endian (x86/ARM), like fur_gen's float writer
+        int ok = 1;
+        cutter_remember(c, pcm, take);
+        if (pcm) {
+            ok = fwrite(pcm, 2, (size_t)take, c->fp) == (size_t)take;
+            pcm += take;
+        } else {
+            for (int64_t left = take; ok && left > 0; ) {
+                size_t chunk = left < 1024 ? (size_t)left : 1024;
+                ok = fwrite(zeros, 2, chunk, c->fp) == chunk;
+                left -= (int64_t)chunk;
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "Error: Cannot write slice %d: %s\n", c->index + 1, strerror(errno));
+            return -1;
+        }
+        c->written += (uint32_t)take;
+        c->pos += take;
+        n -= take;
+
+        if (c->pos >= c->end && cutter_close_slice(c) != 0) return -1;
+    }
+    return 0;
+}
+
+// Close a trailing partial slice. If the audio ended early (the container duration
+// can be a bitrate estimate), the slices that got no audio are written empty.
+static int cutter_finish(SliceCutter *c) {
+    if (c->fp && cutter_close_slice(c) != 0) return -1;
+    if (c->index < c->total_slices) {
+        fprintf(stderr, "Warning: Audio ended before slice %d of %d; the remaining slices are empty.\n",
+                c->index + 1, c->total_slices);
+    }
+    while (c->index < c->total_slices) {
+        if (cutter_open_slice(c) != 0 || cutter_close_slice(c) != 0) return -1;
+    }
+    return 0;
+}
+
+// In-process decoder: demuxer, audio decoder and resampler to 16-bit mono 44.1 kHz
+typedef struct {
+    AVFormatContext *fmt;
+    AVCodecContext *dec;
+    SwrContext *swr;           // set up from the first frame, rebuilt when the input format changes
+    AVChannelLayout in_layout; // input parameters the resampler was set up for
+    int in_format;
+    int in_rate;
+    int stream;
+    int fill_gaps;         // 0 for formats whose timestamps may jump (AVFMT_TS_DISCONT, e.g. MPEG-TS)
+    int64_t start_pts;     // stream start time, in stream time base
+    int64_t ts_offset;     // output samples skipped over at timestamp discontinuities
+    int64_t seg_start;     // output sample position where the current resampler started
+    int64_t in_pos;        // input samples fed to the current resampler
+    int64_t gap_tolerance; // timestamp jitter (in output samples) not treated as a gap
+    int16_t *out;
+    int out_cap;
+    double duration;       // container duration in seconds, as reported by ffprobe
+} AudioDecoder;
+
+static void decoder_close(AudioDecoder *d) {
+    swr_free(&d->swr);
+    av_channel_layout_uninit(&d->in_layout);
+    avcodec_free_context(&d->dec);
+    avformat_close_input(&d->fmt);
+    av_freep(&d->out);
+}
+
+static int decoder_open(AudioDecoder *d, const char *filename) {
+    memset(d, 0, sizeof(*d));
+    av_log_set_level(AV_LOG_ERROR);
+
+    int ret = avformat_open_input(&d->fmt, filename, NULL, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Error: Cannot open '%s': %s\n", filename, av_err2str(ret));
+        return -1;
+    }
+    if ((ret = avformat_find_stream_info(d->fmt, NULL)) < 0) {
+        fprintf(stderr, "Error: Cannot read stream info of '%s': %s\n", filename, av_err2str(ret));
+        decoder_close(d);
+        return -1;
+    }
+
+    const AVCodec *codec = NULL;
+    d->stream = av_find_best_stream(d->fmt, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+    if (d->stream < 0) {
+        fprintf(stderr, "Error: No decodable audio stream in '%s'.\n", filename);
+        decoder_close(d);
+        return -1;
+    }
+    AVStream *st = d->fmt->streams[d->stream];
+
+    d->dec = avcodec_alloc_context3(codec);
+    if (!d->dec ||
+        avcodec_parameters_to_context(d->dec, st->codecpar) < 0 ||
+        (ret = avcodec_open2(d->dec, codec, NULL)) < 0) {
+        fprintf(stderr, "Error: Cannot open audio decoder for '%s'.\n", filename);
+        decoder_close(d);
+        return -1;
+    }
+
+    d->fill_gaps = !(d->fmt->iformat->flags & AVFMT_TS_DISCONT);
+    d->start_pts = (st->start_time != AV_NOPTS_VALUE) ? st->start_time : 0;
+    d->gap_tolerance = av_rescale_q(1, st->time_base, (AVRational){1, OUT_SAMPLE_RATE}) + 1;
+
+    if (d->fmt->duration_estimation_method == AVFMT_DURATION_FROM_BITRATE) {
+        fprintf(stderr, "Warning: Duration of '%s' is estimated from its bitrate; the slice count may be off.\n",
+                filename);
+    }
+    if (d->fmt->duration != AV_NOPTS_VALUE)
+        d->duration = (double)d->fmt->duration / AV_TIME_BASE;
+    else if (st->duration != AV_NOPTS_VALUE)
+        d->duration = (double)st->duration * av_q2d(st->time_base);
+    else
+        d->duration = -1;
+    return 0;
+}
+
+static int decoder_reserve(AudioDecoder *d, int n) {
+    if (n <= d->out_cap) return 0;
+    av_freep(&d->out);
+    d->out = av_malloc_array(n, sizeof(int16_t));
+    if (!d->out) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        d->out_cap = 0;
+        return -1;
+    }
+    d->out_cap = n;
+    return 0;
+}
+
+// Output samples per slice in the ffmpeg CLI path: "-t %.5f" keeps round(len * rate)
+// input samples, and a fresh resampler turns them into this many. Counting them with
+// libswresample itself keeps the slices of both paths the same length.
+static int64_t cli_slice_length(double slice_duration, int in_rate) {
+    static const int16_t zeros[512];
+    int16_t buf[4096];
+    const uint8_t *in = (const uint8_t *)zeros;
+    uint8_t *out = (uint8_t *)buf;
+    AVChannelLayout mono = AV_CHANNEL_LAYOUT_MONO;
+    SwrContext *swr = NULL;
+    int64_t in_left = av_rescale(llround(slice_duration * 1e5), in_rate, 100000);
+    int64_t total = 0;
+
+    int got = swr_alloc_set_opts2(&swr, &mono, AV_SAMPLE_FMT_S16, OUT_SAMPLE_RATE,
+                                  &mono, AV_SAMPLE_FMT_S16, in_rate, 0, NULL);
+    if (got >= 0) got = swr_init(swr);
+    while (got >= 0 && in_left > 0) {
+        int n = in_left < 512 ? (int)in_left : 512;
+        if ((got = swr_convert(swr, &out, 4096, &in, n)) > 0) total += got;
+        in_left -= n;
+    }
+    while (got >= 0 && (got = swr_convert(swr, &out, 4096, NULL, 0)) > 0) total += got;
+    swr_free(&swr);
+    if (got < 0) {
+        fprintf(stderr, "Error: Resampling failed: %s\n", av_err2str(got));
+        return -1;
+    }
+    return total;
+}
+
+// Set up the resampler for the parameters of this frame; its output starts at the
+// cutter's position. The first setup also fixes the slice length.
+static int decoder_setup(AudioDecoder *d, const AVFrame *frame, SliceCutter *c) {
+    AVChannelLayout in_layout;
+    if (frame->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC)
+        av_channel_layout_default(&in_layout, frame->ch_layout.nb_channels);
+    else if (av_channel_layout_copy(&in_layout, &frame->ch_layout) < 0) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        return -1;
+    }
+    AVChannelLayout out_layout = AV_CHANNEL_LAYOUT_MONO;
+
+    int ret = swr_alloc_set_opts2(&d->swr, &out_layout, AV_SAMPLE_FMT_S16, OUT_SAMPLE_RATE,
+                                  &in_layout, frame->format, frame->sample_rate, 0, NULL);
+    av_channel_layout_uninit(&in_layout);
+    if (ret < 0 || (ret = swr_init(d->swr)) < 0) {
+        fprintf(stderr, "Error: Cannot initialize resampler: %s\n", av_err2str(ret));
+        swr_free(&d->swr);
+        return -1;
+    }
+
+    av_channel_layout_uninit(&d->in_layout);
+    if (av_channel_layout_copy(&d->in_layout, &frame->ch_layout) < 0) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        swr_free(&d->swr);
+        return -1;
+    }
+    d->in_format = frame->format;
+    d->in_rate = frame->sample_rate;
+    d->seg_start = c->pos;
+    d->in_pos = 0;
+
+    if (c->slice_len == 0) {
+        c->slice_len = cli_slice_length(c->slice_samples / OUT_SAMPLE_RATE, d->in_rate);
+        if (c->slice_len < 0) return -1;
+    }
+    return 0;
+}
+
+// Drain the resampler's buffered tail into the cutter and free it
+static int decoder_flush(AudioDecoder *d, SliceCutter *c) {
+    if (!d->swr) return 0;
+    if (decoder_reserve(d, 4096) != 0) return -1;
+    int got;
+    while ((got = swr_convert(d->swr, (uint8_t **)&d->out, d->out_cap, NULL, 0)) > 0) {
+        if (cutter_push(c, d->out, got) != 0) return -1;
+    }
+    swr_free(&d->swr);
+    if (got < 0) {
+        fprintf(stderr, "Error: Resampling failed: %s\n", av_err2str(got));
+        return -1;
+    }
+    return 0;
+}
+
+// Resample one decoded frame into the cutter.
+// Errors are reported here or by the cutter; returns -1 on failure.
+static int decoder_convert(AudioDecoder *d, const AVFrame *frame, SliceCutter *c) {
+    // Decoders may change sample format, rate or layout mid-stream (e.g. HE-AAC, chained Ogg)
+    if (d->swr && (frame->format != d->in_format || frame->sample_rate != d->in_rate ||
+                   av_channel_layout_compare(&frame->ch_layout, &d->in_layout) != 0)) {
+        if (decoder_flush(d, c) != 0) return -1;
+    }
+    if (!d->swr && decoder_setup(d, frame, c) != 0) return -1;
+
+    // Place the frame at its timestamp: gaps in the stream become silence
+    // instead of pulling later audio earlier. Both sides are in output samples.
+    if (d->fill_gaps && frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+        AVStream *st = d->fmt->streams[d->stream];
+        int64_t expected = av_rescale_q(frame->best_effort_timestamp - d->start_pts, st->time_base,
+                                        (AVRational){1, OUT_SAMPLE_RATE}) - d->ts_offset;
+        int64_t gap = expected - (d->seg_start + av_rescale(d->in_pos, OUT_SAMPLE_RATE, d->in_rate));
+        if (llabs(gap) > (int64_t)MAX_GAP_SECONDS * OUT_SAMPLE_RATE) {
+            d->ts_offset += gap; // timestamp jump: keep the audio contiguous
+        } else if (gap > d->gap_tolerance) {
+            // Close the resampler segment and write the gap as silence straight into
+            // the slices, so the fill never needs a gap-sized buffer
+            if (decoder_flush(d, c) != 0 ||
+                cutter_push(c, NULL, expected - c->pos) != 0 ||
+                decoder_setup(d, frame, c) != 0) return -1;
+        }
+    }
+
+    int max_out = swr_get_out_samples(d->swr, frame->nb_samples);
+    if (max_out < 0) {
+        fprintf(stderr, "Error: Resampling failed: %s\n", av_err2str(max_out));
+        return -1;
+    }
+    if (decoder_reserve(d, max_out) != 0) return -1;
+    int got = swr_convert(d->swr, (uint8_t **)&d->out, d->out_cap,
+                          (const uint8_t **)frame->extended_data, frame->nb_samples);
+    if (got < 0) {
+        fprintf(stderr, "Error: Resampling failed: %s\n", av_err2str(got));
+        return -1;
+    }
+    d->in_pos += frame->nb_samples;
+    return cutter_push(c, d->out, got);
+}
+
+// Send one packet (NULL to flush) to the decoder and convert every frame it yields.
+// Returns 0, or -1 after reporting the error.
+static int decoder_send(AudioDecoder *d, const AVPacket *pkt, AVFrame *frame, SliceCutter *c) {
+    int ret = avcodec_send_packet(d->dec, pkt);
+    if (ret == AVERROR_INVALIDDATA) return 0; // skip corrupt packets like the ffmpeg CLI does
+
+    while (ret >= 0 && (ret = avcodec_receive_frame(d->dec, frame)) >= 0) {
+        int conv = decoder_convert(d, frame, c);
+        av_frame_unref(frame);
+        if (conv != 0) return -1;
+    }
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) return 0;
+    fprintf(stderr, "Error: Decoding failed: %s\n", av_err2str(ret));
+    return -1;
+}
+
+// Decode the whole audio stream once and cut it into slices
+static int decode_slices(AudioDecoder *d, SliceCutter *c) {
+    AVPacket *pkt = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    if (!pkt || !frame) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        av_packet_free(&pkt);
+        av_frame_free(&frame);
+        return -1;
+    }
+
+    int ret = 0;
+    while (c->index < c->total_slices) {
+        int rd = av_read_frame(d->fmt, pkt);
+        if (rd == AVERROR_EOF) break;
+        if (rd < 0) {
+            fprintf(stderr, "Error: Reading input failed: %s\n", av_err2str(rd));
+            ret = -1;
+            break;
+        }
+        if (pkt->stream_index == d->stream) ret = decoder_send(d, pkt, frame, c);
+        av_packet_unref(pkt);
+        if (ret != 0) break;
+    }
+    // Drain the decoder and the resampler's buffered tail
+    if (ret == 0 && c->index < c->total_slices) {
+        ret = decoder_send(d, NULL, frame, c);
+        if (ret == 0) ret = decoder_flush(d, c);
+    }
+
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+
+    if (ret == 0) ret = cutter_finish(c);
+    if (ret != 0 && c->fp) {
+        fclose(c->fp);
+        c->fp = NULL;
+    }
+    return ret;
+}
+#endif /* USE_LIBAV */
+
 int main(int argc, char *argv[]){
     // Display help message if the user provides --help or -h as an argument
     if(argc == 2 && (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0)) {
@@ -165,9 +639,20 @@ int main(int argc, char *argv[]){
     double slice_duration = seconds_per_row * (double)pattern_rows; // Duration of one slice in seconds
 
     // Get the total duration of the audio file
+#ifdef USE_LIBAV
+    AudioDecoder decoder;
+    if (decoder_open(&decoder, FILENAME) != 0) {
+        return 1;
+    }
+    double total_duration = decoder.duration;
+#else
     double total_duration = get_audio_duration(FILENAME);
+#endif
     if(total_duration < 0) {
         fprintf(stderr, "Error: Could not get audio duration of '%s'.\n", FILENAME);
+#ifdef USE_LIBAV
+        decoder_close(&decoder);
+#endif
         return 1;
     }
 
@@ -176,6 +661,9 @@ int main(int argc, char *argv[]){
     if (total_slices <= 0) {
         fprintf(stderr, "Error: Slice duration (%.5f s) exceeds total duration (%.2f s). No slices to produce.\n",
                 slice_duration, total_duration);
+#ifdef USE_LIBAV
+        decoder_close(&decoder);
+#endif
         return 1;
     }
 
@@ -201,6 +689,9 @@ int main(int argc, char *argv[]){
 #endif
     if (mkdir_ret != 0 && errno != EEXIST) {
         fprintf(stderr, "Error: Could not create output directory '%s': %s\n", output_dir, strerror(errno));
+#ifdef USE_LIBAV
+        decoder_close(&decoder);
+#endif
         return 1;
     }
 
@@ -208,6 +699,21 @@ int main(int argc, char *argv[]){
     printf("Output directory: %s\n", output_dir);
     printf("Slice prefix: %s\n", strlen(slice_prefix) > 0 ? slice_prefix : "(none)");
 
+#ifdef USE_LIBAV
+    // Decode the input once and cut every slice in-process
+    SliceCutter cutter = {
+        .output_dir = output_dir,
+        .slice_prefix = slice_prefix,
+        .naming_mode = naming_mode,
+        .slice_samples = slice_duration * OUT_SAMPLE_RATE,
+        .total_slices = total_slices,
+    };
+    int ret = decode_slices(&decoder, &cutter);
+    decoder_close(&decoder);
+    if (ret != 0) {
+        return 1;
+    }
+#else
     // Pre-escape input filename for use in the loop
     char *escaped_input = shell_escape(FILENAME);
     if (!escaped_input) {
@@ -220,22 +726,9 @@ int main(int argc, char *argv[]){
         // Compute start time from index to avoid cumulative floating-point drift
         double start_time = (double)i * slice_duration;
         char filepath[1024];
-        const char *separator = (strlen(slice_prefix) > 0) ? "_" : "";
 
         // Generate the output file path based on the naming mode
-        if (strcmp(naming_mode, "DEC") == 0) {
-#ifdef _WIN32
-            snprintf(filepath, sizeof(filepath), "%s\\%s%s%02d.wav", output_dir, slice_prefix, separator, i);
-#else
-            snprintf(filepath, sizeof(filepath), "%s/%s%s%02d.wav", output_dir, slice_prefix, separator, i);
-#endif
-        } else {
-#ifdef _WIN32
-            snprintf(filepath, sizeof(filepath), "%s\\%s%s%02X.wav", output_dir, slice_prefix, separator, i);
-#else
-            snprintf(filepath, sizeof(filepath), "%s/%s%s%02X.wav", output_dir, slice_prefix, separator, i);
-#endif
-        }
+        build_slice_path(filepath, sizeof(filepath), output_dir, slice_prefix, naming_mode, i);
 
         // Shell-escape the output filepath
         char *escaped_output = shell_escape(filepath);
@@ -269,6 +762,7 @@ int main(int argc, char *argv[]){
     }
 
     free(escaped_input);
+#endif
 
     // Print success message after all slices are processed
     printf("All slices processed successfully.\n");